@@ -0,0 +1,144 @@
+#ifndef ADAPTIVE_TUNING_H
+#define ADAPTIVE_TUNING_H
+
+#pragma once
+
+#include <vector>
+#include "NoteMap.h"
+
+namespace relivethefuture {
+    /**
+     * @brief Adaptive just intonation retuner.
+     *
+     * Use this when you want chords to settle on pure intervals instead of the fixed
+     * tuning of a NoteMap. Each note-on is retuned relative to the notes already held,
+     * using the intervals of a scala ratio set (typically a just intonation .scl) as the
+     * definition of 'pure'. The interval in note numbers between two voices selects the
+     * ratio, so with a 12 note just scale a major third is always 5/4 whatever the root.
+     *
+     * Retuning is incremental. A note-on only computes the new voice, held voices keep
+     * their pitch while they sound. The new voice is tuned against at most
+     * maxReferenceVoices of the most recently started held notes, which gives note-on a
+     * fixed upper cost independent of the number of voices sounding.
+     *
+     * When nothing is held a note plays at its NoteMap pitch. As each chord is tuned from
+     * the one before, a progression such as C E G# C played legato would otherwise sink by
+     * a diesis every time round. To stop the pitch center wandering, a note is never moved
+     * more than maxOffsetCents away from its NoteMap pitch, intervals that would need more
+     * are left impure.
+     *
+     * Interval ratios and base pitches are precomputed in the constructor, noteOn and
+     * noteOff do no allocation. The class is not thread safe, call it from one thread
+     * (typically the MIDI thread).
+     */
+    class AdaptiveTuning {
+    public:
+        /**
+         * @param noteMap   base tuning, gives the pitch of the first note of a chord
+         * @param ratios    scale ratios as produced by ScalaTuning::parse, starting at 1/1 and
+         *                  ending with the octave. These define the pure intervals.
+         * @param maxReferenceVoices    most held voices a new note is tuned against.
+         * @param maxOffsetCents    furthest a note is retuned from its NoteMap pitch, in cents.
+         *                          The default fits all 5-limit intervals against an untuned note.
+         *
+         * @throws std::invalid_argument if ratios has less than 2 entries, maxReferenceVoices < 1,
+         * maxOffsetCents < 0 or the noteMap has no entries
+         */
+        AdaptiveTuning(const NoteMap & noteMap, const std::vector<double> & ratios, int maxReferenceVoices = 4,
+                       double maxOffsetCents = 25.0);
+
+        /**
+         * @brief Start a voice and retune it against the held notes.
+         * Playing a note that is already held retunes it as if it were new.
+         *
+         * @param noteNumber Probably a midi note number from 0, 127.
+         * @return tuned frequency in Hz for this note
+         */
+        double noteOn(int noteNumber);
+
+        /**
+         * @brief Release a voice. The remaining voices keep their tuning.
+         *
+         * @param noteNumber
+         */
+        void noteOff(int noteNumber);
+
+        /**
+         * @brief Release all voices.
+         */
+        void allNotesOff();
+
+        /**
+         * @brief Current ratio of a note, relative to the NoteMap center frequency.
+         * Notes that aren't held return their NoteMap ratio.
+         *
+         * @param noteNumber
+         * @return note ratio.
+         */
+        double getRatio(int noteNumber) const;
+
+        /**
+         * @param noteNumber
+         * @return current frequency in Hz for this note
+         */
+        double getFrequency(int noteNumber) const;
+
+        /**
+         * @brief Per voice tuning offset, the factor applied to the NoteMap ratio.
+         * 1 means the note is at its NoteMap pitch.
+         *
+         * @param noteNumber
+         * @return offset as a ratio
+         */
+        double getOffset(int noteNumber) const;
+
+        /**
+         * @param noteNumber
+         * @return true if the note is currently held
+         */
+        bool isActive(int noteNumber) const;
+
+        /**
+         * @return The number of held notes.
+         */
+        int getActiveVoiceCount() const;
+
+        /**
+         * @brief Pure ratio between two notes, as defined by the scale ratios.
+         *
+         * @param fromNote
+         * @param toNote
+         * @return ratio of toNote over fromNote, less than 1 when toNote is lower.
+         */
+        double getIntervalRatio(int fromNote, int toNote) const;
+
+    private:
+        int clampNote(int noteNumber) const;
+        void unlink(int noteNumber);
+
+        // Base tuning and its log2, indexed by note number
+        std::vector<double> baseRatios;
+        std::vector<double> baseLog2Ratios;
+        // Pure ratio for an interval of (index - intervalOffset) notes
+        std::vector<double> intervalRatios;
+        std::vector<double> intervalLog2Ratios;
+        int intervalOffset = 0;
+
+        // Tuned ratio of each note and its log2, valid while the note is active
+        std::vector<double> tunedRatios;
+        std::vector<double> tunedLog2Ratios;
+        std::vector<bool> active;
+
+        // Held notes, most recent first, as a doubly linked list over note numbers
+        std::vector<int> previous;
+        std::vector<int> next;
+        int newest = -1;
+        int activeCount = 0;
+
+        int maxReferences;
+        double maxLog2Offset;
+        double centerFrequency;
+    };
+}
+
+#endif
@@ -134,6 +134,12 @@ namespace relivethefuture {
          */
         void setCenterFrequency(double freqInHz);
 
+        /**
+         * @brief Get the frequency of the Center Note
+         * @return frequency in Hz that the 1/1 ratio maps to
+         */
+        double getCenterFrequency() const;
+
         /**
          * @brief How far the Pitch Wheel values will affect the output frequency or ratio
          *
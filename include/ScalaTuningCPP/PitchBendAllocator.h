@@ -0,0 +1,178 @@
+#ifndef PITCH_BEND_ALLOCATOR_H
+#define PITCH_BEND_ALLOCATOR_H
+
+#pragma once
+
+#include <vector>
+#include "NoteMap.h"
+
+namespace relivethefuture {
+    /**
+     * @brief A single channel voice MIDI message.
+     * Pitch bend messages carry the 14-bit value as data1 = lsb, data2 = msb.
+     */
+    struct MidiEvent
+    {
+        unsigned char status;
+        unsigned char data1;
+        unsigned char data2;
+    };
+
+    /**
+     * @brief Plays a NoteMap on synths that only know 12 Tone Equal Temperament.
+     *
+     * Every note is sent as the nearest 12-TET key plus a channel pitch bend. As pitch bend
+     * affects a whole channel each sounding note gets a channel of its own, the allocator
+     * rotates through a block of channels so that simultaneous notes with different bends
+     * don't interfere. The synth must be set to the same pitch bend range as the allocator.
+     *
+     * Channel allocation is O(1). Free channels are reused in the order they were released,
+     * which lets release tails ring out for as long as possible. When every channel is busy
+     * the oldest sounding note is stolen.
+     *
+     * By default channels 1 to 9 (0 to 8) are used, leaving out channel 10 which General MIDI
+     * synths reserve for percussion. Pass a channel block to use more on synths without one.
+     *
+     * Key and bend pairs are precomputed for each note when the NoteMap or bend range is set.
+     * noteOn and noteOff do no allocation, they write MIDI messages into a buffer supplied
+     * by the caller and return how many were written. The class is not thread safe.
+     */
+    class PitchBendAllocator {
+    public:
+        /**
+         * @brief Most messages noteOn can write: a stolen note off, a pitch bend and the note on.
+         */
+        static const int maxEventsPerNoteOn = 3;
+
+        /**
+         * @param noteMap   tuning to play
+         * @param bendRange synth pitch bend range in semitones, up and down.
+         * @param firstChannel  first midi channel to use, from 0 to 15
+         * @param numChannels   how many channels from firstChannel to use. The default stops
+         *                      short of channel 10 (index 9), the General MIDI drum channel.
+         * @param referenceFrequency    frequency of midi key 69 (A4) on the synth
+         *
+         * @throws std::invalid_argument if the channel block isn't within 0 to 15, bendRange or
+         * referenceFrequency aren't positive finite numbers, or the noteMap has no entries
+         */
+        PitchBendAllocator(const NoteMap & noteMap, double bendRange = 2.0, int firstChannel = 0,
+                           int numChannels = 9, double referenceFrequency = 440.0);
+
+        /**
+         * @brief Start a note on a free channel, or steal the oldest one.
+         *
+         * @param noteNumber    note number in the NoteMap
+         * @param velocity  midi velocity 1 to 127, clamped to that range. Use noteOff to stop notes.
+         * @param events    buffer for the messages to send, in order
+         * @param maxEvents size of the buffer, should be at least maxEventsPerNoteOn
+         * @return number of messages written. 0 if the buffer is too small, nothing is played.
+         */
+        int noteOn(int noteNumber, int velocity, MidiEvent * events, int maxEvents);
+
+        /**
+         * @brief Stop a note and free its channel.
+         *
+         * @param noteNumber
+         * @param events
+         * @param maxEvents
+         * @return number of messages written, 0 if the note isn't playing or the buffer is empty.
+         */
+        int noteOff(int noteNumber, MidiEvent * events, int maxEvents);
+
+        /**
+         * @brief Stop every sounding note.
+         *
+         * @param events
+         * @param maxEvents should be at least the number of channels
+         * @return number of messages written. Notes that don't fit are left playing.
+         */
+        int allNotesOff(MidiEvent * events, int maxEvents);
+
+        /**
+         * @brief Rebuild the key and bend table for a new tuning.
+         * Allocates, don't call from the MIDI thread. Sounding notes keep their channels,
+         * notes outside the new mapping size can only be stopped by stealing or allNotesOff.
+         *
+         * @param noteMap
+         *
+         * @throws std::invalid_argument if the noteMap has no entries, the old tuning is kept
+         */
+        void setNoteMap(const NoteMap & noteMap);
+
+        /**
+         * @brief Rebuild the key and bend table for a new synth pitch bend range.
+         * Allocates, don't call from the MIDI thread.
+         *
+         * @param semitones bend range up and down
+         *
+         * @throws std::invalid_argument if semitones isn't a positive finite number
+         */
+        void setPitchBendRange(double semitones);
+
+        /**
+         * @param noteNumber
+         * @return 12-TET midi key used to play this note
+         */
+        int getKey(int noteNumber) const;
+
+        /**
+         * @param noteNumber
+         * @return 14 bit pitch wheel value from 0 to 0x3fff used to play this note
+         */
+        int getPitchBend(int noteNumber) const;
+
+        /**
+         * @param noteNumber
+         * @return channel the note is sounding on, -1 if it isn't playing
+         */
+        int getChannel(int noteNumber) const;
+
+        /**
+         * @return The number of sounding notes.
+         */
+        int getActiveVoiceCount() const;
+
+    private:
+        struct KeyBend
+        {
+            unsigned char key;
+            unsigned short bend;
+        };
+
+        // Channels ordered oldest first, as a doubly linked list over channel slots
+        struct ChannelList
+        {
+            int head = -1;
+            int tail = -1;
+        };
+
+        void buildTable();
+        int clampNote(int noteNumber) const;
+        void pushBack(ChannelList & list, int slot);
+        void remove(ChannelList & list, int slot);
+        MidiEvent releaseSlot(int slot);
+
+        std::vector<double> frequencies;
+        std::vector<KeyBend> keyBends;
+        // Channel slot each note is sounding on, or -1
+        std::vector<int> noteToSlot;
+
+        // Per channel slot state
+        std::vector<int> slotNote;
+        std::vector<unsigned char> slotKey;
+        std::vector<int> slotBend;
+        std::vector<int> slotPrevious;
+        std::vector<int> slotNext;
+
+        ChannelList freeSlots;
+        ChannelList activeSlots;
+        int activeCount = 0;
+
+        double pitchBendRange;
+        int firstChannel;
+        int numChannels;
+        double referenceFrequency;
+    };
+}
+
+#endif
@@ -61,6 +61,11 @@ namespace relivethefuture {
         
     private:
 
+        /**
+         * @brief Does the work for parse, which adds statistics around it.
+         */
+        bool parseRatios(std::string & tuningFileContents, std::vector<double> & ratios);
+
         /**
          * @brief Take a single ratio string and convert to numeric ratio
          *
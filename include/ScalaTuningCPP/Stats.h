@@ -0,0 +1,101 @@
+#ifndef SCALA_TUNING_STATS_H
+#define SCALA_TUNING_STATS_H
+
+#pragma once
+
+#include <cstdint>
+#include <iosfwd>
+
+namespace relivethefuture {
+    /**
+     * @brief Power of two histogram.
+     * Bucket 0 counts values below 2, bucket i counts values from 2^i up to 2^(i+1).
+     */
+    struct StatsHistogram
+    {
+        static const int numBuckets = 64;
+
+        uint64_t buckets[numBuckets] = {};
+
+        /**
+         * @return total number of values recorded
+         */
+        uint64_t getCount() const;
+    };
+
+    /**
+     * @brief Library statistics, totals since startup summed over all threads.
+     *
+     * Statistics are only gathered when the library is built with SCALATUNINGCPP_ENABLE_STATS,
+     * otherwise the recording compiles away to nothing and every snapshot is zero.
+     *
+     * Each thread records into counters of its own with relaxed atomics, so once a thread has
+     * its counters the hot paths never contend. The first recording on a thread allocates
+     * them and takes a lock shared with getStatsSnapshot, call registerStatsThread during
+     * thread setup so that doesn't happen on the audio or MIDI thread.
+     *
+     * getStatsSnapshot can be polled from any thread, e.g. a telemetry thread, it only holds
+     * the lock while copying the list of threads. Values from other threads may be a few
+     * events behind. Take the difference of two snapshots to get rates.
+     */
+    struct StatsSnapshot
+    {
+        // NoteMap::getRatio and everything built on it
+        uint64_t exactLookups = 0;
+        uint64_t interpolatedLookups = 0;
+        uint64_t clampedLookups = 0;
+
+        // ScalaTuning::parse
+        uint64_t parses = 0;
+        uint64_t parseFailures = 0;
+        uint64_t parseBytes = 0;
+        uint64_t parseNanoseconds = 0;
+        StatsHistogram parseTime;
+        StatsHistogram parseBytesPerSecond;
+
+        // NoteMap setRatios, setNoteToRatioMap and resetTo12Tet
+        uint64_t tableRebuilds = 0;
+        uint64_t tableRebuildNanoseconds = 0;
+        StatsHistogram tableRebuildTime;
+
+        /**
+         * @return exact plus interpolated lookups
+         */
+        uint64_t getLookups() const;
+
+        /**
+         * @return average parse throughput, 0 if nothing has been parsed.
+         */
+        double getParseBytesPerSecond() const;
+    };
+
+    /**
+     * @return true if the library was built with SCALATUNINGCPP_ENABLE_STATS
+     */
+    bool statsEnabled();
+
+    /**
+     * @brief Set up the calling thread's counters ahead of its first lookup or parse.
+     * Allocates and takes a lock, call it when starting a realtime thread rather than
+     * from its processing loop. Does nothing when statistics are disabled.
+     */
+    void registerStatsThread();
+
+    /**
+     * @brief Read the current statistics. Takes a lock, don't call from the audio or MIDI thread.
+     *
+     * @return totals over all threads
+     */
+    StatsSnapshot getStatsSnapshot();
+
+    /**
+     * @brief Write a snapshot as one 'name value' pair per line.
+     * Histograms are written as name[bucket] for each non empty bucket.
+     *
+     * @param out
+     * @param snapshot
+     */
+    void writeStats(std::ostream & out, const StatsSnapshot & snapshot);
+}
+
+#endif
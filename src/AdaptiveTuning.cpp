@@ -0,0 +1,165 @@
+
+#include "ScalaTuningCPP/AdaptiveTuning.h"
+
+#include <cmath>
+#include <stdexcept>
+
+namespace relivethefuture {
+
+    AdaptiveTuning::AdaptiveTuning(const NoteMap & noteMap, const std::vector<double> & ratios, int maxReferenceVoices,
+                                   double maxOffsetCents)
+    : maxReferences(maxReferenceVoices), maxLog2Offset(maxOffsetCents / 1200.0) {
+        if(ratios.size() < 2) {
+            throw std::invalid_argument("Need at least 1/1 and an octave ratio");
+        }
+        if(maxReferenceVoices < 1) {
+            throw std::invalid_argument("Need at least one reference voice");
+        }
+        if(maxOffsetCents < 0) {
+            throw std::invalid_argument("Maximum offset can't be negative");
+        }
+        const int mappingSize = noteMap.getMappingSize();
+        if(mappingSize < 1) {
+            throw std::invalid_argument("Note map is empty");
+        }
+
+        centerFrequency = noteMap.getCenterFrequency();
+
+        baseRatios.resize(mappingSize);
+        baseLog2Ratios.resize(mappingSize);
+        for(int i = 0; i < mappingSize; i++) {
+            baseRatios[i] = noteMap.getRatio(i);
+            baseLog2Ratios[i] = std::log2(baseRatios[i]);
+        }
+
+        // Pure intervals repeat every scale octave, same as NoteMap::setRatios
+        const int notesPerOctave = int(ratios.size()) - 1;
+        double octaveSize = ratios[notesPerOctave];
+        if (octaveSize <= 0.00000001)
+        {
+            octaveSize = 1.0;
+        }
+        intervalOffset = mappingSize - 1;
+        intervalRatios.resize(2 * mappingSize - 1);
+        intervalLog2Ratios.resize(2 * mappingSize - 1);
+        for(int interval = 0; interval < mappingSize; interval++) {
+            const double octaveFactor = std::pow(octaveSize, interval / notesPerOctave);
+            const double ratio = octaveFactor * ratios[interval % notesPerOctave];
+            intervalRatios[intervalOffset + interval] = ratio;
+            intervalRatios[intervalOffset - interval] = 1.0 / ratio;
+            intervalLog2Ratios[intervalOffset + interval] = std::log2(ratio);
+            intervalLog2Ratios[intervalOffset - interval] = -std::log2(ratio);
+        }
+
+        tunedRatios.assign(mappingSize, 1.0);
+        tunedLog2Ratios.assign(mappingSize, 0.0);
+        active.assign(mappingSize, false);
+        previous.assign(mappingSize, -1);
+        next.assign(mappingSize, -1);
+    }
+
+    double AdaptiveTuning::noteOn(int noteNumber) {
+        noteNumber = clampNote(noteNumber);
+        if(active[noteNumber]) {
+            unlink(noteNumber);
+        }
+
+        if(newest < 0) {
+            tunedRatios[noteNumber] = baseRatios[noteNumber];
+            tunedLog2Ratios[noteNumber] = baseLog2Ratios[noteNumber];
+        } else {
+            // Average, in pitch space, of where each reference voice puts this note
+            double sum = 0.0;
+            int count = 0;
+            for(int reference = newest; reference >= 0 && count < maxReferences; reference = next[reference]) {
+                sum += tunedLog2Ratios[reference]
+                     + intervalLog2Ratios[intervalOffset + noteNumber - reference];
+                count++;
+            }
+            // Keep near the NoteMap pitch, otherwise legato progressions can pump the
+            // pitch center away by a comma each time round
+            double offset = sum / count - baseLog2Ratios[noteNumber];
+            if(offset > maxLog2Offset) offset = maxLog2Offset;
+            if(offset < -maxLog2Offset) offset = -maxLog2Offset;
+            tunedLog2Ratios[noteNumber] = baseLog2Ratios[noteNumber] + offset;
+            tunedRatios[noteNumber] = std::exp2(tunedLog2Ratios[noteNumber]);
+        }
+
+        active[noteNumber] = true;
+        previous[noteNumber] = -1;
+        next[noteNumber] = newest;
+        if(newest >= 0) {
+            previous[newest] = noteNumber;
+        }
+        newest = noteNumber;
+        activeCount++;
+
+        return getFrequency(noteNumber);
+    }
+
+    void AdaptiveTuning::noteOff(int noteNumber) {
+        noteNumber = clampNote(noteNumber);
+        if(active[noteNumber]) {
+            unlink(noteNumber);
+        }
+    }
+
+    void AdaptiveTuning::allNotesOff() {
+        while(newest >= 0) {
+            unlink(newest);
+        }
+    }
+
+    double AdaptiveTuning::getRatio(int noteNumber) const {
+        noteNumber = clampNote(noteNumber);
+        if(active[noteNumber]) {
+            return tunedRatios[noteNumber];
+        }
+        return baseRatios[noteNumber];
+    }
+
+    double AdaptiveTuning::getFrequency(int noteNumber) const {
+        return getRatio(noteNumber) * centerFrequency;
+    }
+
+    double AdaptiveTuning::getOffset(int noteNumber) const {
+        noteNumber = clampNote(noteNumber);
+        return getRatio(noteNumber) / baseRatios[noteNumber];
+    }
+
+    bool AdaptiveTuning::isActive(int noteNumber) const {
+        return active[clampNote(noteNumber)];
+    }
+
+    int AdaptiveTuning::getActiveVoiceCount() const {
+        return activeCount;
+    }
+
+    double AdaptiveTuning::getIntervalRatio(int fromNote, int toNote) const {
+        return intervalRatios[intervalOffset + clampNote(toNote) - clampNote(fromNote)];
+    }
+
+    int AdaptiveTuning::clampNote(int noteNumber) const {
+        if(noteNumber < 0) return 0;
+        const int mappingSize = int(baseRatios.size());
+        if(noteNumber >= mappingSize) return mappingSize - 1;
+        return noteNumber;
+    }
+
+    void AdaptiveTuning::unlink(int noteNumber) {
+        const int before = previous[noteNumber];
+        const int after = next[noteNumber];
+        if(before >= 0) {
+            next[before] = after;
+        } else {
+            newest = after;
+        }
+        if(after >= 0) {
+            previous[after] = before;
+        }
+        previous[noteNumber] = -1;
+        next[noteNumber] = -1;
+        active[noteNumber] = false;
+        activeCount--;
+    }
+}
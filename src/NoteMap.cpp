@@ -1,5 +1,6 @@
 
 #include "ScalaTuningCPP/NoteMap.h"
+#include "StatsRecorder.h"
 
 #include <cmath>
 #include <utility>
@@ -15,10 +16,15 @@ namespace relivethefuture {
     }
     
     double NoteMap::getRatio(int noteNumber) const {
-        if(noteNumber < 0) noteNumber = 0;
+        if(noteNumber < 0) {
+            stats::count(stats::CLAMPED_LOOKUPS);
+            noteNumber = 0;
+        }
         if(noteNumber >= noteToRatioMap.size()) {
+            stats::count(stats::CLAMPED_LOOKUPS);
             noteNumber = noteToRatioMap.size() - 1;
         }
+        stats::count(stats::EXACT_LOOKUPS);
         return noteToRatioMap.at(noteNumber);
     }
     
@@ -32,13 +38,21 @@ namespace relivethefuture {
     }
 
     double NoteMap::getRatio(double noteNumber) const {
-        if(noteNumber < 0) noteNumber = 0;
+        if(noteNumber < 0) {
+            stats::count(stats::CLAMPED_LOOKUPS);
+            noteNumber = 0;
+        }
         if(noteNumber >= noteToRatioMap.size()) {
+            stats::count(stats::CLAMPED_LOOKUPS);
             noteNumber = noteToRatioMap.size() - 1;
         }
         const auto baseNoteNumber = std::floor(noteNumber);
         const auto nextNoteNumber = std::ceil(noteNumber);
-        if(baseNoteNumber == nextNoteNumber) return noteToRatioMap.at(baseNoteNumber);
+        if(baseNoteNumber == nextNoteNumber) {
+            stats::count(stats::EXACT_LOOKUPS);
+            return noteToRatioMap.at(baseNoteNumber);
+        }
+        stats::count(stats::INTERPOLATED_LOOKUPS);
         
         const auto dn = noteNumber - baseNoteNumber;
         
@@ -67,6 +81,7 @@ namespace relivethefuture {
         }
         else if (numRatios < 128)
         {
+            stats::ScopedTimer timer(stats::TABLE_REBUILDS, stats::TABLE_REBUILD_NANOSECONDS, stats::TABLE_REBUILD_TIME);
             noteToRatioMap.clear();
             
             double octaveSize = ratios[numRatios];
@@ -103,6 +118,7 @@ namespace relivethefuture {
                 noteToRatioMap[i] = octaveBaseRatio * ratios[indexInOctave];
             }
         } else {
+            stats::ScopedTimer timer(stats::TABLE_REBUILDS, stats::TABLE_REBUILD_NANOSECONDS, stats::TABLE_REBUILD_TIME);
             noteToRatioMap.clear();
             // More than 128 ratios, just use them as is
             int i = 0;
@@ -113,6 +129,7 @@ namespace relivethefuture {
     }
     
     void NoteMap::resetTo12Tet() {
+        stats::ScopedTimer timer(stats::TABLE_REBUILDS, stats::TABLE_REBUILD_NANOSECONDS, stats::TABLE_REBUILD_TIME);
         noteToRatioMap.clear();
         for(int i=0;i<128;i++)
         {
@@ -127,6 +144,10 @@ namespace relivethefuture {
     void NoteMap::setCenterFrequency(double freqInHz) {
         centerFrequency = freqInHz;
     }
+
+    double NoteMap::getCenterFrequency() const {
+        return centerFrequency;
+    }
     
     void NoteMap::setPitchBendRange(int up, int down) {
         pitchBendRangeUp = up;
@@ -138,6 +159,7 @@ namespace relivethefuture {
     }
 
     void NoteMap::setNoteToRatioMap(std::map<int, double> ratioMap) {
+        stats::ScopedTimer timer(stats::TABLE_REBUILDS, stats::TABLE_REBUILD_NANOSECONDS, stats::TABLE_REBUILD_TIME);
         noteToRatioMap = ratioMap;
     }
 
@@ -0,0 +1,208 @@
+
+#include "ScalaTuningCPP/PitchBendAllocator.h"
+
+#include <cmath>
+#include <stdexcept>
+
+namespace relivethefuture {
+
+    namespace {
+        const int centerBend = 0x2000;
+        const int maxBend = 0x3FFF;
+    }
+
+    PitchBendAllocator::PitchBendAllocator(const NoteMap & noteMap, double bendRange, int first,
+                                           int channels, double reference)
+    : pitchBendRange(bendRange), firstChannel(first), numChannels(channels), referenceFrequency(reference) {
+        if(firstChannel < 0 || numChannels < 1 || firstChannel + numChannels > 16) {
+            throw std::invalid_argument("Channels must be within 0 to 15");
+        }
+        if(!(pitchBendRange > 0) || !std::isfinite(pitchBendRange)) {
+            throw std::invalid_argument("Pitch bend range must be positive");
+        }
+        if(!(referenceFrequency > 0) || !std::isfinite(referenceFrequency)) {
+            throw std::invalid_argument("Reference frequency must be positive");
+        }
+
+        slotNote.assign(numChannels, -1);
+        slotKey.assign(numChannels, 0);
+        // Unknown bend, so the first note on each channel always sends one
+        slotBend.assign(numChannels, -1);
+        slotPrevious.assign(numChannels, -1);
+        slotNext.assign(numChannels, -1);
+        for(int slot = 0; slot < numChannels; slot++) {
+            pushBack(freeSlots, slot);
+        }
+
+        setNoteMap(noteMap);
+    }
+
+    int PitchBendAllocator::noteOn(int noteNumber, int velocity, MidiEvent * events, int maxEvents) {
+        if(maxEvents < maxEventsPerNoteOn) return 0;
+        noteNumber = clampNote(noteNumber);
+
+        int count = 0;
+        if(noteToSlot[noteNumber] >= 0) {
+            events[count++] = releaseSlot(noteToSlot[noteNumber]);
+        }
+
+        int slot = freeSlots.head;
+        if(slot >= 0) {
+            remove(freeSlots, slot);
+        } else {
+            slot = activeSlots.head;
+            events[count++] = releaseSlot(slot);
+            remove(freeSlots, slot);
+        }
+        pushBack(activeSlots, slot);
+        slotNote[slot] = noteNumber;
+        slotKey[slot] = keyBends[noteNumber].key;
+        noteToSlot[noteNumber] = slot;
+        activeCount++;
+
+        const unsigned char channel = (unsigned char)(firstChannel + slot);
+        const KeyBend & keyBend = keyBends[noteNumber];
+        if(slotBend[slot] != keyBend.bend) {
+            slotBend[slot] = keyBend.bend;
+            events[count++] = { (unsigned char)(0xE0 | channel),
+                                (unsigned char)(keyBend.bend & 0x7F),
+                                (unsigned char)(keyBend.bend >> 7) };
+        }
+        // Velocity 0 would be a note off to the synth while the channel stays allocated here
+        if(velocity < 1) velocity = 1;
+        if(velocity > 127) velocity = 127;
+        events[count++] = { (unsigned char)(0x90 | channel), keyBend.key, (unsigned char)velocity };
+        return count;
+    }
+
+    int PitchBendAllocator::noteOff(int noteNumber, MidiEvent * events, int maxEvents) {
+        if(maxEvents < 1) return 0;
+        noteNumber = clampNote(noteNumber);
+        const int slot = noteToSlot[noteNumber];
+        if(slot < 0) return 0;
+        events[0] = releaseSlot(slot);
+        return 1;
+    }
+
+    int PitchBendAllocator::allNotesOff(MidiEvent * events, int maxEvents) {
+        int count = 0;
+        while(activeSlots.head >= 0 && count < maxEvents) {
+            events[count++] = releaseSlot(activeSlots.head);
+        }
+        return count;
+    }
+
+    void PitchBendAllocator::setNoteMap(const NoteMap & noteMap) {
+        const int mappingSize = noteMap.getMappingSize();
+        if(mappingSize < 1) {
+            throw std::invalid_argument("Note map is empty");
+        }
+        frequencies.resize(mappingSize);
+        for(int i = 0; i < mappingSize; i++) {
+            frequencies[i] = noteMap.getFrequency(i);
+        }
+
+        // Notes beyond the new mapping keep their channel until stolen or allNotesOff
+        noteToSlot.assign(mappingSize, -1);
+        for(int slot = 0; slot < numChannels; slot++) {
+            const int note = slotNote[slot];
+            if(note >= 0 && note < mappingSize) {
+                noteToSlot[note] = slot;
+            }
+        }
+
+        buildTable();
+    }
+
+    void PitchBendAllocator::setPitchBendRange(double semitones) {
+        if(!(semitones > 0) || !std::isfinite(semitones)) {
+            throw std::invalid_argument("Pitch bend range must be positive");
+        }
+        pitchBendRange = semitones;
+        buildTable();
+    }
+
+    int PitchBendAllocator::getKey(int noteNumber) const {
+        return keyBends[clampNote(noteNumber)].key;
+    }
+
+    int PitchBendAllocator::getPitchBend(int noteNumber) const {
+        return keyBends[clampNote(noteNumber)].bend;
+    }
+
+    int PitchBendAllocator::getChannel(int noteNumber) const {
+        const int slot = noteToSlot[clampNote(noteNumber)];
+        if(slot < 0) return -1;
+        return firstChannel + slot;
+    }
+
+    int PitchBendAllocator::getActiveVoiceCount() const {
+        return activeCount;
+    }
+
+    void PitchBendAllocator::buildTable() {
+        keyBends.resize(frequencies.size());
+        for(size_t i = 0; i < frequencies.size(); i++) {
+            const double exactKey = 69.0 + 12.0 * std::log2(frequencies[i] / referenceFrequency);
+            double key = std::round(exactKey);
+            if(key < 0) key = 0;
+            if(key > 127) key = 127;
+
+            int bend = centerBend + int(std::lround((exactKey - key) / pitchBendRange * centerBend));
+            if(bend < 0) bend = 0;
+            if(bend > maxBend) bend = maxBend;
+
+            keyBends[i].key = (unsigned char)key;
+            keyBends[i].bend = (unsigned short)bend;
+        }
+    }
+
+    int PitchBendAllocator::clampNote(int noteNumber) const {
+        if(noteNumber < 0) return 0;
+        const int mappingSize = int(keyBends.size());
+        if(noteNumber >= mappingSize) return mappingSize - 1;
+        return noteNumber;
+    }
+
+    void PitchBendAllocator::pushBack(ChannelList & list, int slot) {
+        slotPrevious[slot] = list.tail;
+        slotNext[slot] = -1;
+        if(list.tail >= 0) {
+            slotNext[list.tail] = slot;
+        } else {
+            list.head = slot;
+        }
+        list.tail = slot;
+    }
+
+    void PitchBendAllocator::remove(ChannelList & list, int slot) {
+        const int before = slotPrevious[slot];
+        const int after = slotNext[slot];
+        if(before >= 0) {
+            slotNext[before] = after;
+        } else {
+            list.head = after;
+        }
+        if(after >= 0) {
+            slotPrevious[after] = before;
+        } else {
+            list.tail = before;
+        }
+        slotPrevious[slot] = -1;
+        slotNext[slot] = -1;
+    }
+
+    MidiEvent PitchBendAllocator::releaseSlot(int slot) {
+        const int note = slotNote[slot];
+        // Note off with the key it was started on, even if the table has changed since
+        const MidiEvent event { (unsigned char)(0x80 | (firstChannel + slot)), slotKey[slot], 0 };
+        if(note < int(noteToSlot.size())) {
+            noteToSlot[note] = -1;
+        }
+        slotNote[slot] = -1;
+        remove(activeSlots, slot);
+        pushBack(freeSlots, slot);
+        activeCount--;
+        return event;
+    }
+}
@@ -1,4 +1,5 @@
 #include "ScalaTuningCPP/ScalaTuning.h"
+#include "StatsRecorder.h"
 
 #include <cmath>
 #include <iostream>
@@ -32,6 +33,31 @@ namespace relivethefuture {
     }
     
     bool ScalaTuning::parse(std::string & tuning, std::vector<double> & ratios) {
+        stats::ScopedTimer timer(stats::PARSES, stats::PARSE_NANOSECONDS, stats::PARSE_TIME);
+        const auto recordParse = [&](bool success) {
+            stats::count(stats::PARSE_BYTES, tuning.size());
+            const auto nanoseconds = timer.getNanoseconds();
+            if(nanoseconds > 0) {
+                stats::record(stats::PARSE_BYTES_PER_SECOND, tuning.size() * 1000000000ull / nanoseconds);
+            }
+            if(!success) {
+                stats::count(stats::PARSE_FAILURES);
+            }
+        };
+
+        bool success = false;
+        try {
+            success = parseRatios(tuning, ratios);
+        } catch(...) {
+            // Bad ratios in some places throw rather than return false, still a failure
+            recordParse(false);
+            throw;
+        }
+        recordParse(success);
+        return success;
+    }
+
+    bool ScalaTuning::parseRatios(std::string & tuning, std::vector<double> & ratios) {
 
         bool inComment = false;
 
@@ -0,0 +1,162 @@
+
+#include "StatsRecorder.h"
+
+#include <ostream>
+
+#ifdef SCALATUNINGCPP_ENABLE_STATS
+#include <memory>
+#include <mutex>
+#include <vector>
+#endif
+
+namespace relivethefuture {
+
+#ifdef SCALATUNINGCPP_ENABLE_STATS
+    namespace stats {
+
+        namespace {
+            struct Registry
+            {
+                std::mutex mutex;
+                // Every block ever handed out, blocks are never freed so totals survive thread exit
+                std::vector<std::unique_ptr<ThreadStats>> all;
+                std::vector<ThreadStats *> unused;
+            };
+
+            Registry & registry() {
+                static Registry * instance = new Registry();
+                return *instance;
+            }
+        }
+
+        ThreadStats * acquireThreadStats() {
+            Registry & reg = registry();
+            std::lock_guard<std::mutex> lock(reg.mutex);
+            if(!reg.unused.empty()) {
+                ThreadStats * threadStats = reg.unused.back();
+                reg.unused.pop_back();
+                return threadStats;
+            }
+            std::unique_ptr<ThreadStats> threadStats(new ThreadStats());
+            for(auto & counter : threadStats->counters) {
+                counter.store(0, std::memory_order_relaxed);
+            }
+            for(auto & histogram : threadStats->histograms) {
+                for(auto & bucket : histogram) {
+                    bucket.store(0, std::memory_order_relaxed);
+                }
+            }
+            reg.all.push_back(std::move(threadStats));
+            return reg.all.back().get();
+        }
+
+        void releaseThreadStats(ThreadStats * threadStats) {
+            Registry & reg = registry();
+            std::lock_guard<std::mutex> lock(reg.mutex);
+            reg.unused.push_back(threadStats);
+        }
+    }
+
+    namespace {
+        void addHistogram(StatsHistogram & histogram, const std::atomic<uint64_t> * buckets) {
+            for(int i = 0; i < StatsHistogram::numBuckets; i++) {
+                histogram.buckets[i] += buckets[i].load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    bool statsEnabled() {
+        return true;
+    }
+
+    void registerStatsThread() {
+        stats::local();
+    }
+
+    StatsSnapshot getStatsSnapshot() {
+        StatsSnapshot snapshot;
+        // Only hold the lock to copy the block list, blocks are never freed so they can be
+        // summed afterwards without keeping a registering thread waiting.
+        std::vector<const stats::ThreadStats *> blocks;
+        {
+            stats::Registry & reg = stats::registry();
+            std::lock_guard<std::mutex> lock(reg.mutex);
+            blocks.reserve(reg.all.size());
+            for(const auto & threadStats : reg.all) {
+                blocks.push_back(threadStats.get());
+            }
+        }
+        for(const auto threadStats : blocks) {
+            const auto counter = [&](stats::Counter c) {
+                return threadStats->counters[c].load(std::memory_order_relaxed);
+            };
+            snapshot.exactLookups += counter(stats::EXACT_LOOKUPS);
+            snapshot.interpolatedLookups += counter(stats::INTERPOLATED_LOOKUPS);
+            snapshot.clampedLookups += counter(stats::CLAMPED_LOOKUPS);
+            snapshot.parses += counter(stats::PARSES);
+            snapshot.parseFailures += counter(stats::PARSE_FAILURES);
+            snapshot.parseBytes += counter(stats::PARSE_BYTES);
+            snapshot.parseNanoseconds += counter(stats::PARSE_NANOSECONDS);
+            snapshot.tableRebuilds += counter(stats::TABLE_REBUILDS);
+            snapshot.tableRebuildNanoseconds += counter(stats::TABLE_REBUILD_NANOSECONDS);
+            addHistogram(snapshot.parseTime, threadStats->histograms[stats::PARSE_TIME]);
+            addHistogram(snapshot.parseBytesPerSecond, threadStats->histograms[stats::PARSE_BYTES_PER_SECOND]);
+            addHistogram(snapshot.tableRebuildTime, threadStats->histograms[stats::TABLE_REBUILD_TIME]);
+        }
+        return snapshot;
+    }
+#else
+    bool statsEnabled() {
+        return false;
+    }
+
+    void registerStatsThread() {
+    }
+
+    StatsSnapshot getStatsSnapshot() {
+        return StatsSnapshot();
+    }
+#endif
+
+    uint64_t StatsHistogram::getCount() const {
+        uint64_t count = 0;
+        for(const auto bucket : buckets) {
+            count += bucket;
+        }
+        return count;
+    }
+
+    uint64_t StatsSnapshot::getLookups() const {
+        return exactLookups + interpolatedLookups;
+    }
+
+    double StatsSnapshot::getParseBytesPerSecond() const {
+        if(parseNanoseconds == 0) return 0.0;
+        return double(parseBytes) * 1e9 / double(parseNanoseconds);
+    }
+
+    namespace {
+        void writeHistogram(std::ostream & out, const char * name, const StatsHistogram & histogram) {
+            for(int i = 0; i < StatsHistogram::numBuckets; i++) {
+                if(histogram.buckets[i] != 0) {
+                    out << name << "[" << i << "] " << histogram.buckets[i] << "\n";
+                }
+            }
+        }
+    }
+
+    void writeStats(std::ostream & out, const StatsSnapshot & snapshot) {
+        out << "exactLookups " << snapshot.exactLookups << "\n";
+        out << "interpolatedLookups " << snapshot.interpolatedLookups << "\n";
+        out << "clampedLookups " << snapshot.clampedLookups << "\n";
+        out << "parses " << snapshot.parses << "\n";
+        out << "parseFailures " << snapshot.parseFailures << "\n";
+        out << "parseBytes " << snapshot.parseBytes << "\n";
+        out << "parseNanoseconds " << snapshot.parseNanoseconds << "\n";
+        writeHistogram(out, "parseTime", snapshot.parseTime);
+        writeHistogram(out, "parseBytesPerSecond", snapshot.parseBytesPerSecond);
+        out << "tableRebuilds " << snapshot.tableRebuilds << "\n";
+        out << "tableRebuildNanoseconds " << snapshot.tableRebuildNanoseconds << "\n";
+        writeHistogram(out, "tableRebuildTime", snapshot.tableRebuildTime);
+    }
+}
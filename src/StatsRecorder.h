@@ -0,0 +1,129 @@
+#ifndef SCALA_TUNING_STATS_RECORDER_H
+#define SCALA_TUNING_STATS_RECORDER_H
+
+#pragma once
+
+// Internal recording side of Stats.h, only included by the library sources.
+// Without SCALATUNINGCPP_ENABLE_STATS everything here is an empty inline function.
+
+#include "ScalaTuningCPP/Stats.h"
+
+#ifdef SCALATUNINGCPP_ENABLE_STATS
+#include <atomic>
+#include <chrono>
+#endif
+
+namespace relivethefuture {
+    namespace stats {
+
+        enum Counter
+        {
+            EXACT_LOOKUPS,
+            INTERPOLATED_LOOKUPS,
+            CLAMPED_LOOKUPS,
+            PARSES,
+            PARSE_FAILURES,
+            PARSE_BYTES,
+            PARSE_NANOSECONDS,
+            TABLE_REBUILDS,
+            TABLE_REBUILD_NANOSECONDS,
+            NUM_COUNTERS
+        };
+
+        enum Histogram
+        {
+            PARSE_TIME,
+            PARSE_BYTES_PER_SECOND,
+            TABLE_REBUILD_TIME,
+            NUM_HISTOGRAMS
+        };
+
+#ifdef SCALATUNINGCPP_ENABLE_STATS
+
+        // Counters for one thread. Only that thread writes, so a relaxed load and store is
+        // enough and snapshots read them from other threads without tearing.
+        struct ThreadStats
+        {
+            std::atomic<uint64_t> counters[NUM_COUNTERS];
+            std::atomic<uint64_t> histograms[NUM_HISTOGRAMS][StatsHistogram::numBuckets];
+        };
+
+        // Hands out a block for the calling thread, registered for snapshots
+        ThreadStats * acquireThreadStats();
+        // Called at thread exit, the block and its totals are kept for the next thread
+        void releaseThreadStats(ThreadStats * threadStats);
+
+        struct ThreadStatsHandle
+        {
+            ThreadStats * threadStats = acquireThreadStats();
+            ~ThreadStatsHandle() { releaseThreadStats(threadStats); }
+        };
+
+        inline ThreadStats & local() {
+            static thread_local ThreadStatsHandle handle;
+            return *handle.threadStats;
+        }
+
+        inline void increment(std::atomic<uint64_t> & value, uint64_t amount) {
+            value.store(value.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+        }
+
+        inline void count(Counter counter, uint64_t amount = 1) {
+            increment(local().counters[counter], amount);
+        }
+
+        inline void record(Histogram histogram, uint64_t value) {
+            int bucket = 0;
+            while(value > 1) {
+                value >>= 1;
+                bucket++;
+            }
+            increment(local().histograms[histogram][bucket], 1);
+        }
+
+        /**
+         * @brief Counts one event and adds its duration to a total and a histogram
+         */
+        class ScopedTimer {
+        public:
+            ScopedTimer(Counter events, Counter nanoseconds, Histogram histogram)
+            : eventCounter(events), nanosecondCounter(nanoseconds), timeHistogram(histogram),
+              start(std::chrono::steady_clock::now()) {}
+
+            ~ScopedTimer() {
+                const uint64_t nanoseconds = getNanoseconds();
+                count(eventCounter);
+                count(nanosecondCounter, nanoseconds);
+                record(timeHistogram, nanoseconds);
+            }
+
+            uint64_t getNanoseconds() const {
+                return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now() - start).count();
+            }
+
+        private:
+            Counter eventCounter;
+            Counter nanosecondCounter;
+            Histogram timeHistogram;
+            std::chrono::steady_clock::time_point start;
+        };
+
+#else
+
+        inline void count(Counter, uint64_t = 1) {}
+
+        inline void record(Histogram, uint64_t) {}
+
+        class ScopedTimer {
+        public:
+            ScopedTimer(Counter, Counter, Histogram) {}
+
+            uint64_t getNanoseconds() const { return 0; }
+        };
+
+#endif
+    }
+}
+
+#endif
@@ -0,0 +1,131 @@
+#include <ScalaTuningCPP/AdaptiveTuning.h>
+
+#include <gtest/gtest.h>
+#include <cmath>
+#include <stdexcept>
+
+static const std::vector<double> albionRatios {
+    1,
+    16.0/15.0,
+    9.0/8.0,
+    6.0/5.0,
+    5.0/4.0,
+    4.0/3.0,
+    64.0/45.0,
+    3.0/2.0,
+    8.0/5.0,
+    5.0/3.0,
+    16.0/9.0,
+    15.0/8.0,
+    2.0/1.0
+};
+
+TEST(AdaptiveTuning, firstNoteUsesNoteMap) {
+    relivethefuture::NoteMap noteMap;
+    relivethefuture::AdaptiveTuning tuning(noteMap, albionRatios);
+
+    EXPECT_DOUBLE_EQ(noteMap.getFrequency(64), tuning.noteOn(64));
+    EXPECT_DOUBLE_EQ(1.0, tuning.getOffset(64));
+}
+
+TEST(AdaptiveTuning, followsCenterFrequency) {
+    relivethefuture::NoteMap noteMap;
+    noteMap.setCenterFrequency(440.0);
+    relivethefuture::AdaptiveTuning tuning(noteMap, albionRatios);
+
+    EXPECT_DOUBLE_EQ(440.0, tuning.noteOn(60));
+    EXPECT_DOUBLE_EQ(440.0 * 1.5, tuning.noteOn(67));
+}
+
+TEST(AdaptiveTuning, majorTriadIsPure) {
+    relivethefuture::NoteMap noteMap;
+    relivethefuture::AdaptiveTuning tuning(noteMap, albionRatios);
+
+    tuning.noteOn(60);
+    tuning.noteOn(64);
+    tuning.noteOn(67);
+
+    EXPECT_DOUBLE_EQ(1.0, tuning.getRatio(60));
+    EXPECT_DOUBLE_EQ(5.0/4.0, tuning.getRatio(64));
+    EXPECT_DOUBLE_EQ(3.0/2.0, tuning.getRatio(67));
+    EXPECT_EQ(3, tuning.getActiveVoiceCount());
+}
+
+TEST(AdaptiveTuning, intervalsRepeatAndInvert) {
+    relivethefuture::NoteMap noteMap;
+    relivethefuture::AdaptiveTuning tuning(noteMap, albionRatios);
+
+    EXPECT_DOUBLE_EQ(5.0/2.0, tuning.getIntervalRatio(60, 76));
+    EXPECT_DOUBLE_EQ(2.0/3.0, tuning.getIntervalRatio(67, 60));
+}
+
+TEST(AdaptiveTuning, heldVoicesDontMove) {
+    relivethefuture::NoteMap noteMap;
+    relivethefuture::AdaptiveTuning tuning(noteMap, albionRatios);
+
+    tuning.noteOn(62);
+    tuning.noteOn(65);
+    const double held = tuning.getRatio(65);
+    tuning.noteOff(62);
+    tuning.noteOn(69);
+
+    EXPECT_DOUBLE_EQ(held, tuning.getRatio(65));
+    EXPECT_DOUBLE_EQ(held * 5.0/4.0, tuning.getRatio(69));
+    EXPECT_FALSE(tuning.isActive(62));
+    EXPECT_DOUBLE_EQ(noteMap.getRatio(62), tuning.getRatio(62));
+}
+
+TEST(AdaptiveTuning, referenceVoicesAreBounded) {
+    relivethefuture::NoteMap noteMap;
+    relivethefuture::AdaptiveTuning tuning(noteMap, albionRatios, 1);
+
+    tuning.noteOn(60);
+    tuning.noteOn(64);
+    tuning.noteOn(67);
+
+    // Only tuned against the E, a pure minor third above it.
+    EXPECT_DOUBLE_EQ(5.0/4.0 * 6.0/5.0, tuning.getRatio(67));
+
+    tuning.allNotesOff();
+    EXPECT_EQ(0, tuning.getActiveVoiceCount());
+}
+
+TEST(AdaptiveTuning, commaPumpIsBounded) {
+    relivethefuture::NoteMap noteMap;
+    relivethefuture::AdaptiveTuning tuning(noteMap, albionRatios);
+
+    // Overlapping major thirds C E G# C, each a pure 5/4 above the last
+    const int progression[] = { 60, 64, 68, 72, 76, 80, 84 };
+    int previous = -1;
+    for(const int note : progression) {
+        tuning.noteOn(note);
+        if(previous >= 0) tuning.noteOff(previous);
+        previous = note;
+    }
+
+    const double cents = 1200.0 * std::log2(tuning.getOffset(84));
+    EXPECT_GE(cents, -25.0 - 1e-9);
+    EXPECT_LE(cents, 25.0 + 1e-9);
+}
+
+TEST(AdaptiveTuning, maxOffsetClampsIntervals) {
+    relivethefuture::NoteMap noteMap;
+    relivethefuture::AdaptiveTuning tuning(noteMap, albionRatios, 4, 5.0);
+
+    tuning.noteOn(60);
+    tuning.noteOn(64);
+
+    // 5/4 is 13.7 cents flat of 12-TET, only 5 allowed
+    EXPECT_NEAR(-5.0, 1200.0 * std::log2(tuning.getOffset(64)), 1e-9);
+}
+
+TEST(AdaptiveTuning, invalidArguments) {
+    relivethefuture::NoteMap noteMap;
+    EXPECT_THROW(relivethefuture::AdaptiveTuning(noteMap, {1.0}), std::invalid_argument);
+    EXPECT_THROW(relivethefuture::AdaptiveTuning(noteMap, albionRatios, 0), std::invalid_argument);
+    EXPECT_THROW(relivethefuture::AdaptiveTuning(noteMap, albionRatios, 4, -1.0), std::invalid_argument);
+
+    // Single degree scales leave the NoteMap empty
+    relivethefuture::NoteMap emptyNoteMap({ 1.0, 2.0 });
+    EXPECT_THROW(relivethefuture::AdaptiveTuning(emptyNoteMap, albionRatios), std::invalid_argument);
+}
@@ -6,6 +6,7 @@ TEST(NoteMap, default12Tet) {
     relivethefuture::NoteMap noteMap;
     EXPECT_EQ(1, noteMap.getRatio(60));
     EXPECT_EQ(261.63, noteMap.getFrequency(60));
+    EXPECT_EQ(261.63, noteMap.getCenterFrequency());
 }
 
 TEST(NoteMap, albionRatios) {
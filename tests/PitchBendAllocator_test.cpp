@@ -0,0 +1,146 @@
+#include <ScalaTuningCPP/PitchBendAllocator.h>
+
+#include <gtest/gtest.h>
+#include <cmath>
+#include <stdexcept>
+
+TEST(PitchBendAllocator, twelveTetNeedsNoBend) {
+    relivethefuture::NoteMap noteMap;
+    noteMap.setCenterFrequency(440.0 * std::pow(2.0, -9.0 / 12.0));
+    relivethefuture::PitchBendAllocator allocator(noteMap);
+
+    EXPECT_EQ(60, allocator.getKey(60));
+    EXPECT_EQ(0x2000, allocator.getPitchBend(60));
+}
+
+TEST(PitchBendAllocator, eighthToneBend) {
+    std::vector<double> eighthTones;
+    for(int i = 0; i <= 48; i++) {
+        eighthTones.push_back(std::pow(2.0, i / 48.0));
+    }
+    relivethefuture::NoteMap noteMap(eighthTones);
+    noteMap.setCenterFrequency(440.0);
+    relivethefuture::PitchBendAllocator allocator(noteMap, 2.0);
+
+    // A quarter semitone up is an eighth of a 2 semitone bend range
+    EXPECT_EQ(69, allocator.getKey(61));
+    EXPECT_EQ(0x2000 + 0x400, allocator.getPitchBend(61));
+
+    allocator.setPitchBendRange(1.0);
+    EXPECT_EQ(0x2000 + 0x800, allocator.getPitchBend(61));
+}
+
+TEST(PitchBendAllocator, noteOnSendsBendThenNote) {
+    relivethefuture::NoteMap noteMap;
+    relivethefuture::PitchBendAllocator allocator(noteMap, 2.0, 1, 2);
+    relivethefuture::MidiEvent events[relivethefuture::PitchBendAllocator::maxEventsPerNoteOn];
+
+    ASSERT_EQ(2, allocator.noteOn(60, 100, events, 3));
+    const int bend = allocator.getPitchBend(60);
+    EXPECT_EQ(0xE1, events[0].status);
+    EXPECT_EQ(bend & 0x7F, events[0].data1);
+    EXPECT_EQ(bend >> 7, events[0].data2);
+    EXPECT_EQ(0x91, events[1].status);
+    EXPECT_EQ(allocator.getKey(60), events[1].data1);
+    EXPECT_EQ(100, events[1].data2);
+    EXPECT_EQ(1, allocator.getChannel(60));
+
+    ASSERT_EQ(1, allocator.noteOff(60, events, 3));
+    EXPECT_EQ(0x81, events[0].status);
+    EXPECT_EQ(-1, allocator.getChannel(60));
+    EXPECT_EQ(0, allocator.noteOff(60, events, 3));
+}
+
+TEST(PitchBendAllocator, channelsRotateAndStealOldest) {
+    relivethefuture::NoteMap noteMap;
+    relivethefuture::PitchBendAllocator allocator(noteMap, 2.0, 0, 2);
+    relivethefuture::MidiEvent events[relivethefuture::PitchBendAllocator::maxEventsPerNoteOn];
+
+    allocator.noteOn(60, 100, events, 3);
+    allocator.noteOn(64, 100, events, 3);
+    EXPECT_EQ(0, allocator.getChannel(60));
+    EXPECT_EQ(1, allocator.getChannel(64));
+
+    // Same bend as the stolen note, so only the note off and note on
+    ASSERT_EQ(2, allocator.noteOn(67, 100, events, 3));
+    EXPECT_EQ(0x80, events[0].status);
+    EXPECT_EQ(allocator.getKey(60), events[0].data1);
+    EXPECT_EQ(-1, allocator.getChannel(60));
+    EXPECT_EQ(0, allocator.getChannel(67));
+    EXPECT_EQ(2, allocator.getActiveVoiceCount());
+
+    // Channel 1 was released first so is reused first, already bent correctly
+    allocator.noteOff(64, events, 3);
+    allocator.noteOff(67, events, 3);
+    ASSERT_EQ(1, allocator.noteOn(64, 100, events, 3));
+    EXPECT_EQ(0x91, events[0].status);
+
+    EXPECT_EQ(1, allocator.allNotesOff(events, 3));
+    EXPECT_EQ(0, allocator.getActiveVoiceCount());
+}
+
+TEST(PitchBendAllocator, smallBufferPlaysNothing) {
+    relivethefuture::NoteMap noteMap;
+    relivethefuture::PitchBendAllocator allocator(noteMap);
+    relivethefuture::MidiEvent events[2];
+
+    EXPECT_EQ(0, allocator.noteOn(60, 100, events, 2));
+    EXPECT_EQ(0, allocator.getActiveVoiceCount());
+}
+
+TEST(PitchBendAllocator, velocityIsClamped) {
+    relivethefuture::NoteMap noteMap;
+    relivethefuture::PitchBendAllocator allocator(noteMap);
+    relivethefuture::MidiEvent events[relivethefuture::PitchBendAllocator::maxEventsPerNoteOn];
+
+    // Neither may reach the synth as velocity 0, which it would take as a note off
+    const int zeroCount = allocator.noteOn(72, 0, events, 3);
+    EXPECT_EQ(1, events[zeroCount - 1].data2);
+
+    const int overCount = allocator.noteOn(70, 128, events, 3);
+    EXPECT_EQ(127, events[overCount - 1].data2);
+    EXPECT_EQ(2, allocator.getActiveVoiceCount());
+}
+
+TEST(PitchBendAllocator, defaultSkipsDrumChannel) {
+    relivethefuture::NoteMap noteMap;
+    relivethefuture::PitchBendAllocator allocator(noteMap);
+    relivethefuture::MidiEvent events[relivethefuture::PitchBendAllocator::maxEventsPerNoteOn];
+
+    for(int note = 60; note < 76; note++) {
+        allocator.noteOn(note, 100, events, 3);
+        EXPECT_NE(9, allocator.getChannel(note));
+    }
+    EXPECT_EQ(9, allocator.getActiveVoiceCount());
+}
+
+TEST(PitchBendAllocator, invalidChannels) {
+    relivethefuture::NoteMap noteMap;
+    EXPECT_THROW(relivethefuture::PitchBendAllocator(noteMap, 2.0, 8, 9), std::invalid_argument);
+    EXPECT_THROW(relivethefuture::PitchBendAllocator(noteMap, 0.0), std::invalid_argument);
+}
+
+TEST(PitchBendAllocator, invalidRanges) {
+    relivethefuture::NoteMap noteMap;
+    EXPECT_THROW(relivethefuture::PitchBendAllocator(noteMap, std::nan("")), std::invalid_argument);
+    EXPECT_THROW(relivethefuture::PitchBendAllocator(noteMap, INFINITY), std::invalid_argument);
+    EXPECT_THROW(relivethefuture::PitchBendAllocator(noteMap, 2.0, 0, 9, 0.0), std::invalid_argument);
+    EXPECT_THROW(relivethefuture::PitchBendAllocator(noteMap, 2.0, 0, 9, std::nan("")), std::invalid_argument);
+
+    relivethefuture::PitchBendAllocator allocator(noteMap);
+    EXPECT_THROW(allocator.setPitchBendRange(std::nan("")), std::invalid_argument);
+}
+
+TEST(PitchBendAllocator, emptyNoteMap) {
+    // Single degree scales leave the NoteMap empty
+    relivethefuture::NoteMap emptyNoteMap({ 1.0, 2.0 });
+    EXPECT_THROW(relivethefuture::PitchBendAllocator allocator(emptyNoteMap), std::invalid_argument);
+
+    relivethefuture::NoteMap noteMap;
+    relivethefuture::PitchBendAllocator allocator(noteMap);
+    EXPECT_THROW(allocator.setNoteMap(emptyNoteMap), std::invalid_argument);
+
+    relivethefuture::MidiEvent events[relivethefuture::PitchBendAllocator::maxEventsPerNoteOn];
+    EXPECT_EQ(2, allocator.noteOn(60, 100, events, 3));
+    EXPECT_EQ(allocator.getKey(60), events[1].data1);
+}
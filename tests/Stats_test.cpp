@@ -0,0 +1,113 @@
+#include <ScalaTuningCPP/Stats.h>
+#include <ScalaTuningCPP/ScalaTuning.h>
+
+#include <gtest/gtest.h>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+TEST(Stats, lookups) {
+    relivethefuture::NoteMap noteMap;
+    const auto before = relivethefuture::getStatsSnapshot();
+
+    noteMap.getRatio(60);
+    noteMap.getRatio(200);
+    noteMap.getRatio(60.5);
+
+    const auto after = relivethefuture::getStatsSnapshot();
+    if(!relivethefuture::statsEnabled()) {
+        EXPECT_EQ(0u, after.getLookups());
+        return;
+    }
+    EXPECT_EQ(2u, after.exactLookups - before.exactLookups);
+    EXPECT_EQ(1u, after.interpolatedLookups - before.interpolatedLookups);
+    EXPECT_EQ(1u, after.clampedLookups - before.clampedLookups);
+}
+
+TEST(Stats, parseAndRebuild) {
+    relivethefuture::ScalaTuning scalaTuning;
+    std::string contents = "Test\n 2\n 3/2\n 2/1\n";
+    std::string broken = "Test\n 3\n 3/2\n";
+    std::vector<double> ratios;
+    const auto before = relivethefuture::getStatsSnapshot();
+
+    ASSERT_TRUE(scalaTuning.parse(contents, ratios));
+    ratios.clear();
+    ASSERT_FALSE(scalaTuning.parse(broken, ratios));
+    relivethefuture::NoteMap noteMap;
+    // Single degree scales leave the table alone, so aren't a rebuild
+    noteMap.setRatios({ 1.0, 2.0 });
+
+    const auto after = relivethefuture::getStatsSnapshot();
+    if(!relivethefuture::statsEnabled()) {
+        EXPECT_EQ(0u, after.parses);
+        EXPECT_EQ(0u, after.tableRebuilds);
+        return;
+    }
+    EXPECT_EQ(2u, after.parses - before.parses);
+    EXPECT_EQ(1u, after.parseFailures - before.parseFailures);
+    EXPECT_EQ(contents.size() + broken.size(), after.parseBytes - before.parseBytes);
+    EXPECT_EQ(2u, after.parseTime.getCount() - before.parseTime.getCount());
+    EXPECT_EQ(1u, after.tableRebuilds - before.tableRebuilds);
+    EXPECT_EQ(1u, after.tableRebuildTime.getCount() - before.tableRebuildTime.getCount());
+}
+
+TEST(Stats, parseExceptionCountsAsFailure) {
+    relivethefuture::ScalaTuning scalaTuning;
+    // A ratio ended by a comment that doesn't parse throws from std::stod
+    std::string contents = "x\n 1\n abc ! c\n";
+    std::vector<double> ratios;
+    const auto before = relivethefuture::getStatsSnapshot();
+
+    EXPECT_THROW(scalaTuning.parse(contents, ratios), std::invalid_argument);
+
+    const auto after = relivethefuture::getStatsSnapshot();
+    if(!relivethefuture::statsEnabled()) return;
+    EXPECT_EQ(1u, after.parses - before.parses);
+    EXPECT_EQ(1u, after.parseFailures - before.parseFailures);
+    EXPECT_EQ(contents.size(), after.parseBytes - before.parseBytes);
+}
+
+TEST(Stats, totalsKeptAfterThreadExit) {
+    const auto before = relivethefuture::getStatsSnapshot();
+
+    std::thread worker([] {
+        relivethefuture::NoteMap noteMap;
+        noteMap.getRatio(-1);
+    });
+    worker.join();
+
+    const auto after = relivethefuture::getStatsSnapshot();
+    if(!relivethefuture::statsEnabled()) return;
+    EXPECT_EQ(1u, after.clampedLookups - before.clampedLookups);
+    EXPECT_EQ(1u, after.tableRebuilds - before.tableRebuilds);
+}
+
+TEST(Stats, registerThreadBeforeLookups) {
+    const auto before = relivethefuture::getStatsSnapshot();
+
+    std::thread worker([] {
+        relivethefuture::registerStatsThread();
+        relivethefuture::registerStatsThread();
+        relivethefuture::NoteMap noteMap;
+        noteMap.getRatio(60.5);
+    });
+    worker.join();
+
+    const auto after = relivethefuture::getStatsSnapshot();
+    if(!relivethefuture::statsEnabled()) return;
+    EXPECT_EQ(1u, after.interpolatedLookups - before.interpolatedLookups);
+}
+
+TEST(Stats, writeStats) {
+    relivethefuture::StatsSnapshot snapshot;
+    snapshot.parses = 3;
+    snapshot.tableRebuildTime.buckets[10] = 2;
+
+    std::ostringstream out;
+    relivethefuture::writeStats(out, snapshot);
+
+    EXPECT_NE(std::string::npos, out.str().find("parses 3\n"));
+    EXPECT_NE(std::string::npos, out.str().find("tableRebuildTime[10] 2\n"));
+    EXPECT_EQ(std::string::npos, out.str().find("parseTime["));
+}